@@ -10,13 +10,18 @@ Instructions  : ***********************************************************
                     ./Project Files/Assessment.pdf
                     ./Project Files/JNY ICD - v1.0.pdf
 Expected Use  : ***********************************************************
-                compile: "g++ main.cpp"
+                compile: "g++ main.cpp" (add "-pthread" on Linux, "-O3 -fno-math-errno" to vectorize FleetKinematics)
                 execute: "Kelly_final.exe"
+                resume:  "Kelly_final.exe --resume [--extend N] [--snapshot FILE]"
+                physics: "Kelly_final.exe --kinematic" (PID steered tracks, see FleetKinematics)
+                geofence mask: "Kelly_final.exe --build-mask zones.MASK" once, then add "--mask zones.MASK"
 Expected Output : *********************************************************
                 Journey Files:
                     ./<vehicle_id>.JNY
                     ./<vehicle_id>.JNY
                     ...
+                Fleet Snapshot (periodic, for --resume):
+                    ./FLEET.SNAP
                 Example: CAR.JNY
                     CAR,Campagnola,3860,5.18,6.4,13.2,Fiat,1981,SPORTS,REGULAR
                     40.1547,-105.174,0
@@ -86,9 +91,22 @@ History       : ***********************************************************
 #include <list>
 //#include <format> // "C++20"
 #include <fstream>
+#include <functional>
+#include <thread>
 #include <time.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <math.h>
+#ifdef _WIN32
+    #define NOMINMAX // keep std::min/std::max usable
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
 #include "GeoCalc.cpp"
 //#include "point-in-poly.cpp"
@@ -106,6 +124,21 @@ struct historicPoint {
     double elapsedTime;
 };
 
+// Everything needed to pick a vehicle's journey back up where it left off.
+// See Vehicle::GetSnapshot() and SerializeFleetSnapshot().
+struct vehicleSnapshot {
+    location currentLocation;
+    double currentBearing;
+    double lastElapsedTime;
+    uint64_t rngState;
+    int64_t outputOffset;   // bytes of <ident>.JNY written so far
+    int32_t waypointsDone;
+    int32_t waypointsTotal;
+    string logTail;         // last few characters logged, checked against the log on resume
+};
+
+const size_t logTailLength = 64;
+
 struct geoFenceZone {
     location zoneNW;
     location zoneNE;
@@ -150,8 +183,16 @@ class Vehicle {
         // Record Position History
         double currentBearing;
         location currentLocation;
+        double lastElapsedTime;
         std::list<struct historicPoint> pointsHistory;
 
+        // Generation state, everything a snapshot needs to resume
+        uint64_t rngState;      // per-vehicle, unlike rand(), so it can be saved
+        int64_t outputOffset;   // bytes written to <ident>.JNY
+        string logTail;         // last logTailLength characters logged, without any "\r"
+        int waypointsDone;
+        int waypointsTotal;
+
         // Basic Vehicle properties
         string ident;
         string descrip;
@@ -193,9 +234,7 @@ class Vehicle {
             SetPowerType(powerType);
             SetDraft(draftFt);
             SetManufacturer(manufacturer);
-            SetBearing(0.0);
-            LogMessage(Identify(),true); //start/restart log
-            srand (time(NULL)); // init rand at object creation
+            InitJourneyState();
         }
 
         //Car constructor
@@ -211,9 +250,7 @@ class Vehicle {
             SetYear(year);
             SetBodyStyle(body_style);
             SetFuelType(fuel);
-            SetBearing(0.0);
-            LogMessage(Identify(),true); //start/restart log
-            srand (time(NULL)); // init rand at object creation
+            InitJourneyState();
             // SetUnspecified0(unspecified0);
             // SetUnspecified1(unspecified1);
         }
@@ -239,9 +276,19 @@ class Vehicle {
             SetWidth(width);
             SetHeight(height);
             SetLength(length);
+            InitJourneyState();
+        }
+
+        void InitJourneyState(){
             SetBearing(0.0);
-            LogMessage(Identify(),true); //start/restart log
-            srand (time(NULL)); // init rand at object creation
+            currentLocation = {0.0, 0.0};
+            lastElapsedTime = 0.0;
+            outputOffset = 0;
+            logTail.clear();
+            waypointsDone = 0;
+            waypointsTotal = 0;
+            // init rand at object creation, mixed with ident so vehicles don't share a sequence
+            SetRandomSeed((uint64_t)time(NULL) ^ std::hash<string>()(GetIdent()));
         }
 
         void SetIdent(string id){
@@ -355,9 +402,38 @@ class Vehicle {
             }
         }
 
+        void SetRandomSeed(uint64_t seed){
+            rngState = seed;
+        }
+
+        int NextRandom(){
+            // 64-bit LCG (Knuth MMIX constants), upper bits as a non-negative int like rand()
+            rngState = rngState * 6364136223846793005ULL + 1442695040888963407ULL;
+            return (int)(rngState >> 33);
+        }
+
+        void SetWaypointsTotal(int total){
+            if (total >= waypointsDone){
+                waypointsTotal = total;
+            }
+        }
+
+        int GetWaypointsTotal(){
+            return waypointsTotal;
+        }
+
+        int GetWaypointsDone(){
+            return waypointsDone;
+        }
+
+        bool JourneyComplete(){
+            return waypointsDone >= waypointsTotal;
+        }
+
         void AddToWaypointHistory(location point, double epoch){
             historicPoint curPoint = { point, epoch };
             pointsHistory.push_back(curPoint); //most recent point at the end
+            lastElapsedTime = epoch;
             std::ostringstream stringStream;
             stringStream << curPoint.thisWaypoint.latitude << "," << curPoint.thisWaypoint.longitude << "," << curPoint.elapsedTime  << "\n";
             std::string msgCopyOfStr = stringStream.str();
@@ -371,7 +447,8 @@ class Vehicle {
         }
 
         double GetPreviousWaypointTime(){
-            return pointsHistory.back().elapsedTime;
+            // not pointsHistory.back(), history is not carried across a resume
+            return lastElapsedTime;
         }
 
         struct location GetLocation(){
@@ -406,7 +483,7 @@ class Vehicle {
             return draftFt;
         }
 
-        string GetIdent(){
+        const string& GetIdent(){
             return ident;
         }
 
@@ -443,20 +520,60 @@ class Vehicle {
             return msgCopyOfStr;
         }
 
+        void StartLog(){
+            LogMessage(Identify(),true); //start/restart log
+        }
+
         void LogMessage(string message, bool restartLog = false){
+            logTail = (restartLog ? "" : logTail) + message;
+            if (logTail.size() > logTailLength){
+                logTail.erase(0, logTail.size() - logTailLength);
+            }
             if(restartLog){
                 ofstream LogFile(GetIdent()+".JNY");
                 LogFile << message;
+                outputOffset = LogFile.tellp(); // actual bytes, "\r\n" on Windows
                 LogFile.close();
             } else {
                 ofstream LogFile(GetIdent()+".JNY", std::ios_base::app); //append
                 LogFile << message;
+                outputOffset = LogFile.tellp();
                 LogFile.close();
             }
         }
+
+        vehicleSnapshot GetSnapshot(){
+            vehicleSnapshot snap;
+            snap.currentLocation = currentLocation;
+            snap.currentBearing = currentBearing;
+            snap.lastElapsedTime = lastElapsedTime;
+            snap.rngState = rngState;
+            snap.outputOffset = outputOffset;
+            snap.waypointsDone = waypointsDone;
+            snap.waypointsTotal = waypointsTotal;
+            snap.logTail = logTail;
+            return snap;
+        }
+
+        void RestoreSnapshot(const vehicleSnapshot &snap){
+            // the log itself is checked and truncated by LoadFleetSnapshot()
+            currentLocation = snap.currentLocation;
+            currentBearing = snap.currentBearing;
+            lastElapsedTime = snap.lastElapsedTime;
+            rngState = snap.rngState;
+            outputOffset = snap.outputOffset;
+            logTail = snap.logTail;
+            waypointsDone = snap.waypointsDone;
+            waypointsTotal = snap.waypointsTotal;
+            pointsHistory.clear();
+        }
+
+        void RecordWaypointDone(){
+            waypointsDone++;
+        }
 };
 
-double bearingGen(Vehicle someVehicle){
+double bearingGen(Vehicle &someVehicle){
     /**
      * Some numerical linear algebra would be useful in calculating vectors
      * to add some intelligence - particularly with geoFences
@@ -464,25 +581,28 @@ double bearingGen(Vehicle someVehicle){
 
     string vehicle_type = someVehicle.GetIdent();
     double currentBearing = someVehicle.GetBearing();
-    double newBearing;
+    double newBearing = currentBearing;
     if(vehicle_type == "CAR"){
         // Car Bearing Sanity Check: Cars cannot turn more than 90 degrees between waypoints
-        newBearing = currentBearing + ( rand() % 180 ) - 90;
+        newBearing = currentBearing + ( someVehicle.NextRandom() % 180 ) - 90;
         // if(abs(currentBearing-newBearing) > 90){
         //     cout << "\nCar Bearing:" << currentBearing << "," << newBearing << "\n";
         // } else throw?
     } else if (vehicle_type == "BOAT") {
         // Boat Bearing Sanity Check: Boats cannot turn more than 30 degrees between waypoints
-        newBearing = currentBearing + ( rand() % 60 ) - 30;
+        newBearing = currentBearing + ( someVehicle.NextRandom() % 60 ) - 30;
         // if(abs(currentBearing-newBearing) > 30){
         //     cout << "\nBoat Bearing:" << currentBearing << "," << newBearing << "\n";
         // } else throw?
     }
-    someVehicle.SetBearing(newBearing);
-    return someVehicle.GetBearing();
+    // as SetBearing() would: out of range bearings are rejected, the vehicle itself is not turned
+    if(newBearing <= 360 && 0 <= newBearing){
+        return newBearing;
+    }
+    return currentBearing;
 }
 
-double groundSpeedGen(Vehicle someVehicle){
+double groundSpeedGen(Vehicle &someVehicle){
      /**
       * Instantaneous velocity changes, controller windup,...
       * stoichiometry -> M mph -> N fps
@@ -496,16 +616,16 @@ double groundSpeedGen(Vehicle someVehicle){
     double mphToFps = 1.46666;
     double groundspeedFps = 0.0;
     if(vehicle_type == "CAR"){
-        groundspeedFps = (rand() % 35 + 25)*mphToFps;
+        groundspeedFps = (someVehicle.NextRandom() % 35 + 25)*mphToFps;
     } else if (vehicle_type == "BOAT") {
         string powerType = someVehicle.GetPowerType();
         if(powerType == "MOTOR"){
-            groundspeedFps = (rand() % 35 + 25)*mphToFps;
+            groundspeedFps = (someVehicle.NextRandom() % 35 + 25)*mphToFps;
         } else if (powerType == "SAIL")
         {
-            groundspeedFps = (rand() % 15 + 15)*mphToFps;
+            groundspeedFps = (someVehicle.NextRandom() % 15 + 15)*mphToFps;
         } else if (powerType == "UNPOWERED") {
-            groundspeedFps = (rand() % 10 + 1)*mphToFps;
+            groundspeedFps = (someVehicle.NextRandom() % 10 + 1)*mphToFps;
         }
     }
     // Not specified
@@ -515,7 +635,7 @@ double groundSpeedGen(Vehicle someVehicle){
     return groundspeedFps;
 }
 
-bool geoFenceCheck(Vehicle someVehicle, location point){
+bool boatZoneCheck(location point){
     /**
      * Point-in-polygon (PIP) problem
      *  Test cases: inside, outside, edge
@@ -528,109 +648,987 @@ bool geoFenceCheck(Vehicle someVehicle, location point){
      *  https://www.codeproject.com/Articles/62482/A-Simple-Geo-Fencing-Using-Polygon-Method
      */
 
-    if(abs(point.latitude) > 90 || abs(point.longitude) > 180){
-        return false; // invalid location
+    //rudimentary check
+    for (auto const& this_zone : boatZones) {
+        bool lat_valid = false;
+        bool lon_valid = false;
+        //Check Latitude (north and south points)
+        if (point.latitude >= 0){
+            if (point.latitude < this_zone.zoneNW.latitude &&
+                this_zone.zoneSW.latitude < point.latitude){
+                lat_valid = true;
+            }
+        } else {
+            if (point.latitude > this_zone.zoneNW.latitude &&
+                this_zone.zoneSW.latitude < point.latitude){
+                lon_valid = true;
+            }
+        }
+
+        //Check Longitude (east and west points)
+        if (point.longitude >= 0){
+            if (this_zone.zoneNW.longitude > point.longitude &&
+                point.longitude > this_zone.zoneNE.longitude){
+                lat_valid = true;
+            }
+        } else {
+            if (this_zone.zoneNW.longitude < point.longitude &&
+                point.longitude < this_zone.zoneNE.longitude){
+                lon_valid = true;
+            }
+        }
+        if(lat_valid && lon_valid){
+            return true;
+        }
     }
-    if(someVehicle.GetIdent() == "BOAT"){
-        //rudimentary check
-        for (auto const& this_zone : boatZones) {
-            bool lat_valid = false;
-            bool lon_valid = false;
-            //Check Latitude (north and south points)
-            if (point.latitude >= 0){
-                if (point.latitude < this_zone.zoneNW.latitude &&
-                    this_zone.zoneSW.latitude < point.latitude){
-                    lat_valid = true;
-                }
+    return false;
+}
+
+// === Boat Zone Mask ===
+/**
+ * Precomputed raster of boatZoneCheck() so most lookups are one or two array
+ * reads instead of testing every zone. Two levels over [-90,90] x [-180,180]:
+ *   coarse: 1 degree cells, uint32 each: maskOutside, maskInside, or 2 + tile index
+ *   tiles:  maskTileDim x maskTileDim uint8 subcells: maskOutside, maskInside, or maskExact
+ * maskExact subcells (on a zone edge) fall back to boatZoneCheck().
+ *
+ * File layout (native byte order): boatMaskHeader | coarse cells | tiles.
+ * It is memory-mapped read-only, so startup is instant and worker processes
+ * using the same file share its pages.
+ */
+const char maskMagic[4] = {'J','N','Y','M'};
+const uint32_t maskVersion = 1;
+const uint32_t maskRows = 180;
+const uint32_t maskCols = 360;
+const uint32_t maskTileDim = 16;
+const uint8_t maskOutside = 0;
+const uint8_t maskInside = 1;
+const uint8_t maskExact = 2;
+
+struct boatMaskHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t tileDim;
+    uint32_t tileCount;
+    uint64_t zonesFingerprint;  // a mask built for other zones is rejected on load
+};
+
+uint64_t boatZonesFingerprint(){
+    // FNV-1a over the corner coordinates
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto const& this_zone : boatZones) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&this_zone);
+        for (size_t i = 0; i < sizeof(geoFenceZone); i++){
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+std::vector<double> representativeValues(double low, double high, std::vector<double> &breakpoints){
+    /**
+     * boatZoneCheck() only compares a coordinate against 0 and the zone
+     * corners, so along one axis it is constant between those breakpoints.
+     * One value per breakpoint in [low, high] and one in each gap between
+     * them covers every distinct outcome in the range.
+     */
+    std::vector<double> edges;
+    edges.push_back(low);
+    for (double b : breakpoints) {
+        if (low < b && b < high){
+            edges.push_back(b);
+        }
+    }
+    edges.push_back(high);
+    std::vector<double> values;
+    for (size_t i = 0; i < edges.size(); i++){
+        values.push_back(edges[i]);
+        if (i + 1 < edges.size()){
+            values.push_back((edges[i] + edges[i + 1]) / 2.0);
+        }
+    }
+    return values;
+}
+
+uint8_t classifyMaskCell(double latLow, double latHigh, double lonLow, double lonHigh,
+                        std::vector<double> &latBreaks, std::vector<double> &lonBreaks){
+    // widened slightly so a point rounded into a neighbouring cell is still covered
+    const double epsilon = 1e-9;
+    std::vector<double> lats = representativeValues(latLow - epsilon, latHigh + epsilon, latBreaks);
+    std::vector<double> lons = representativeValues(lonLow - epsilon, lonHigh + epsilon, lonBreaks);
+    bool anyInside = false;
+    bool anyOutside = false;
+    for (double lat : lats) {
+        for (double lon : lons) {
+            location point = {lat, lon};
+            if (boatZoneCheck(point)){
+                anyInside = true;
             } else {
-                if (point.latitude > this_zone.zoneNW.latitude &&
-                    this_zone.zoneSW.latitude < point.latitude){
-                    lon_valid = true;
-                }
+                anyOutside = true;
             }
+        }
+    }
+    if (anyInside && anyOutside){
+        return maskExact;
+    }
+    return anyInside ? maskInside : maskOutside;
+}
 
-            //Check Longitude (east and west points)
-            if (point.longitude >= 0){
-                if (this_zone.zoneNW.longitude > point.longitude &&
-                    point.longitude > this_zone.zoneNE.longitude){
-                    lat_valid = true;
-                }
-            } else {
-                if (this_zone.zoneNW.longitude < point.longitude &&
-                    point.longitude < this_zone.zoneNE.longitude){
-                    lon_valid = true;
+bool BuildBoatZoneMask(string fileName){
+    std::vector<double> latBreaks = {0.0};
+    std::vector<double> lonBreaks = {0.0};
+    for (auto const& this_zone : boatZones) {
+        for (location corner : {this_zone.zoneNW, this_zone.zoneNE, this_zone.zoneSE, this_zone.zoneSW}) {
+            latBreaks.push_back(corner.latitude);
+            lonBreaks.push_back(corner.longitude);
+        }
+    }
+
+    std::vector<uint32_t> coarse(maskRows * maskCols);
+    std::vector<uint8_t> tiles;
+    double subcell = 1.0 / maskTileDim;
+    for (uint32_t r = 0; r < maskRows; r++){
+        double latLow = -90.0 + r;
+        for (uint32_t c = 0; c < maskCols; c++){
+            double lonLow = -180.0 + c;
+            uint8_t code = classifyMaskCell(latLow, latLow + 1.0, lonLow, lonLow + 1.0, latBreaks, lonBreaks);
+            if (code != maskExact){
+                coarse[r * maskCols + c] = code;
+                continue;
+            }
+            coarse[r * maskCols + c] = 2 + (uint32_t)(tiles.size() / (maskTileDim * maskTileDim));
+            for (uint32_t sr = 0; sr < maskTileDim; sr++){
+                for (uint32_t sc = 0; sc < maskTileDim; sc++){
+                    double subLat = latLow + sr * subcell;
+                    double subLon = lonLow + sc * subcell;
+                    tiles.push_back(classifyMaskCell(subLat, subLat + subcell, subLon, subLon + subcell,
+                                                    latBreaks, lonBreaks));
                 }
             }
-            if(lat_valid && lon_valid){
-                return true;
+        }
+    }
+
+    boatMaskHeader header;
+    std::copy(maskMagic, maskMagic + sizeof(maskMagic), header.magic);
+    header.version = maskVersion;
+    header.rows = maskRows;
+    header.cols = maskCols;
+    header.tileDim = maskTileDim;
+    header.tileCount = (uint32_t)(tiles.size() / (maskTileDim * maskTileDim));
+    header.zonesFingerprint = boatZonesFingerprint();
+
+    ofstream out(fileName, std::ios_base::binary | std::ios_base::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(coarse.data()), coarse.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(tiles.data()), tiles.size());
+    out.close();
+    return (bool)out;
+}
+
+class BoatZoneMask {
+        const unsigned char* base = nullptr;
+        size_t size = 0;
+        const uint32_t* coarse = nullptr;
+        const uint8_t* tiles = nullptr;
+        uint32_t tileCount = 0;
+#ifdef _WIN32
+        HANDLE fileHandle = INVALID_HANDLE_VALUE;
+        HANDLE mappingHandle = NULL;
+#endif
+
+        bool Map(string fileName){
+#ifdef _WIN32
+            fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (fileHandle == INVALID_HANDLE_VALUE){
+                return false;
+            }
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0){
+                return false;
+            }
+            size = (size_t)fileSize.QuadPart;
+            mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mappingHandle == NULL){
+                return false;
+            }
+            base = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+            return base != nullptr;
+#else
+            int fd = open(fileName.c_str(), O_RDONLY);
+            if (fd < 0){
+                return false;
+            }
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0){
+                close(fd);
+                return false;
             }
+            size = (size_t)fileStat.st_size;
+            void* mapped = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd); // the mapping keeps its own reference
+            if (mapped == MAP_FAILED){
+                return false;
+            }
+            base = static_cast<const unsigned char*>(mapped);
+            return true;
+#endif
         }
-        return false;
+
+    public:
+        ~BoatZoneMask(){
+            Close();
+        }
+
+        bool Open(string fileName){
+            Close();
+            if (!Map(fileName) || size < sizeof(boatMaskHeader)){
+                Close();
+                return false;
+            }
+            const boatMaskHeader* header = reinterpret_cast<const boatMaskHeader*>(base);
+            size_t coarseBytes = (size_t)maskRows * maskCols * sizeof(uint32_t);
+            size_t tileSize = (size_t)maskTileDim * maskTileDim;
+            // the tile count is taken from the file size rather than multiplied out,
+            // so a corrupt count can't wrap a 32-bit size_t and pass the check
+            if (!std::equal(maskMagic, maskMagic + sizeof(maskMagic), header->magic) ||
+                header->version != maskVersion || header->rows != maskRows ||
+                header->cols != maskCols || header->tileDim != maskTileDim ||
+                header->zonesFingerprint != boatZonesFingerprint() ||
+                size - sizeof(boatMaskHeader) < coarseBytes ||
+                (size - sizeof(boatMaskHeader) - coarseBytes) % tileSize != 0 ||
+                header->tileCount != (size - sizeof(boatMaskHeader) - coarseBytes) / tileSize){
+                Close();
+                return false;
+            }
+            coarse = reinterpret_cast<const uint32_t*>(base + sizeof(boatMaskHeader));
+            tiles = reinterpret_cast<const uint8_t*>(base + sizeof(boatMaskHeader) + coarseBytes);
+            tileCount = header->tileCount;
+            return true;
+        }
+
+        void Close(){
+#ifdef _WIN32
+            if (base != nullptr){
+                UnmapViewOfFile(base);
+            }
+            if (mappingHandle != NULL){
+                CloseHandle(mappingHandle);
+            }
+            if (fileHandle != INVALID_HANDLE_VALUE){
+                CloseHandle(fileHandle);
+            }
+            mappingHandle = NULL;
+            fileHandle = INVALID_HANDLE_VALUE;
+#else
+            if (base != nullptr){
+                munmap(const_cast<unsigned char*>(base), size);
+            }
+#endif
+            base = nullptr;
+            size = 0;
+            coarse = nullptr;
+            tiles = nullptr;
+            tileCount = 0;
+        }
+
+        bool IsLoaded(){
+            return coarse != nullptr;
+        }
+
+        uint8_t Lookup(location point){
+            // caller has already range checked the point
+            double latOffset = point.latitude + 90.0;
+            double lonOffset = point.longitude + 180.0;
+            uint32_t r = std::min((uint32_t)latOffset, maskRows - 1);
+            uint32_t c = std::min((uint32_t)lonOffset, maskCols - 1);
+            uint32_t cell = coarse[r * maskCols + c];
+            if (cell < 2){
+                return (uint8_t)cell;
+            }
+            if (cell - 2 >= tileCount){
+                return maskExact; // corrupt index, checked here rather than scanning the table on Open()
+            }
+            uint32_t sr = std::min((uint32_t)((latOffset - r) * maskTileDim), maskTileDim - 1);
+            uint32_t sc = std::min((uint32_t)((lonOffset - c) * maskTileDim), maskTileDim - 1);
+            return tiles[(size_t)(cell - 2) * maskTileDim * maskTileDim + sr * maskTileDim + sc];
+        }
+};
+
+BoatZoneMask boatZoneMask; // optional, see --mask
+
+bool geoFenceCheck(Vehicle &someVehicle, location point){
+    if(abs(point.latitude) > 90 || abs(point.longitude) > 180){
+        return false; // invalid location
+    }
+    if(someVehicle.GetIdent() == "BOAT"){
+        if (boatZoneMask.IsLoaded()){
+            uint8_t code = boatZoneMask.Lookup(point);
+            if (code == maskInside){
+                return true;
+            } else if (code == maskOutside){
+                return false;
+            } // anything else, including a corrupt byte, gets the exact check
+        }
+        return boatZoneCheck(point);
     } else {
         return true;
     }
 }
 
-void GenerateWaypointHistory(Vehicle aVehicle){
-    srand (time(NULL));
-    int num_waypoints = rand() % 20 + 10; // 10 to 30 waypoints, inclusive.
-
-    for (int i = 0; i <= num_waypoints; i++){
-        double endLatitude;
-        double endLongitude;
-        double startBearing;
-        double distanceFeet;
-        location vehicle_location = aVehicle.GetLocation();
-        double startLatitude = vehicle_location.latitude;
-        double startLongitude = vehicle_location.longitude;
-        bool validLocation = false;
-
-        /*
-        Would be helped by some linear algebra ... rather than brute force
-            randomly retrying bearings and directions to get a valid end location.
-        */
-        while (!validLocation){
-            startBearing = bearingGen(aVehicle);
-            distanceFeet = rand() % 221760;  // just going some random theoretical distance 0 to 49 miles
+void PlanWaypointHistory(Vehicle &aVehicle){
+    int num_waypoints = aVehicle.NextRandom() % 20 + 10; // 10 to 30 waypoints, inclusive.
+    aVehicle.SetWaypointsTotal(aVehicle.GetWaypointsDone() + num_waypoints + 1);
+}
 
-            //Provided in Project Files
-            GeoCalc::GetEndingCoordinates(startLatitude, startLongitude,
-                                            startBearing, distanceFeet,
-                                            &endLatitude, &endLongitude);
-            location vehicle_destination = {endLatitude, endLongitude};
-            validLocation = geoFenceCheck(aVehicle, vehicle_destination);
+location destinationGen(Vehicle &aVehicle){
+    double startBearing;
+    double endLatitude;
+    double endLongitude;
+    double distanceFeet;
+    location vehicle_location = aVehicle.GetLocation();
+    double startLatitude = vehicle_location.latitude;
+    double startLongitude = vehicle_location.longitude;
+    bool validLocation = false;
+    int attempts = 0;
+
+    /*
+    Would be helped by some linear algebra ... rather than brute force
+        randomly retrying bearings and directions to get a valid end location.
+    */
+    while (!validLocation){
+        if (++attempts <= 100){
+            startBearing = bearingGen(aVehicle);
+        } else {
+            // heading straight at a geofence edge, every bearingGen() turn is rejected: turn around
+            startBearing = aVehicle.NextRandom() % 360;
         }
+        distanceFeet = aVehicle.NextRandom() % 221760;  // just going some random theoretical distance 0 to 49 miles
 
         //Provided in Project Files
-        GeoCalc::GetGreatCircleDistance(startLatitude, startLongitude,
-                                    endLatitude, endLongitude,
-                                    &distanceFeet);
+        GeoCalc::GetEndingCoordinates(startLatitude, startLongitude,
+                                        startBearing, distanceFeet,
+                                        &endLatitude, &endLongitude);
+        location vehicle_destination = {endLatitude, endLongitude};
+        validLocation = geoFenceCheck(aVehicle, vehicle_destination);
+    }
+    location destination = {endLatitude, endLongitude};
+    return destination;
+}
+
+void GenerateWaypoint(Vehicle &aVehicle){
+    double distanceFeet;
+    location vehicle_location = aVehicle.GetLocation();
+    location destination = destinationGen(aVehicle);
+    double endLatitude = destination.latitude;
+    double endLongitude = destination.longitude;
+
+    //Provided in Project Files
+    GeoCalc::GetGreatCircleDistance(vehicle_location.latitude, vehicle_location.longitude,
+                                endLatitude, endLongitude,
+                                &distanceFeet);
 
-        double groundSpeedFps = groundSpeedGen(aVehicle);
-        double segmentTravelTime = distanceFeet/groundSpeedFps;
+    double groundSpeedFps = groundSpeedGen(aVehicle);
+    double segmentTravelTime = distanceFeet/groundSpeedFps;
 
-        location thisPoint = {endLatitude, endLongitude};
-        double elapsedTime = segmentTravelTime + aVehicle.GetPreviousWaypointTime();
-        aVehicle.SetLocation(thisPoint);
+    location thisPoint = {endLatitude, endLongitude};
+    double elapsedTime = segmentTravelTime + aVehicle.GetPreviousWaypointTime();
+    aVehicle.SetLocation(thisPoint);
 
-        //Test: check elapsed time is always increasing
-        aVehicle.AddToWaypointHistory(thisPoint,elapsedTime);
+    //Test: check elapsed time is always increasing
+    aVehicle.AddToWaypointHistory(thisPoint,elapsedTime);
+    aVehicle.RecordWaypointDone();
+}
+
+// === Fleet Snapshots ===
+/**
+ * Layout (native byte order, no padding):
+ *   "JNYS" | uint32 version | uint32 vehicle count
+ *   per vehicle: uint32 ident length | ident | vehicleSnapshot fields in declaration order,
+ *                logTail as uint32 length | characters
+ * Snapshots are only meant to be resumed on the machine/build that wrote them.
+ *
+ * The JNY files have no room for a run id (their format is fixed by the ICD),
+ * so each snapshot instead carries the tail of every log it describes, and a
+ * resume is refused unless every log still ends with that tail at the
+ * recorded offset.
+ */
+const char snapshotMagic[4] = {'J','N','Y','S'};
+const uint32_t snapshotVersion = 3;
+const int checkpointInterval = 5; // waypoints between snapshots
+const uint32_t maxIdentLength = 256;
+
+int64_t FileSize(string fileName){
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(fileName.c_str(), GetFileExInfoStandard, &info)){
+        return -1;
+    }
+    return ((int64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+#else
+    struct stat fileStat;
+    if (stat(fileName.c_str(), &fileStat) != 0){
+        return -1;
+    }
+    return (int64_t)fileStat.st_size;
+#endif
+}
+
+bool TruncateFile(string fileName, int64_t length){
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileA(fileName.c_str(), GENERIC_WRITE, 0, NULL,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE){
+        return false;
+    }
+    LARGE_INTEGER position;
+    position.QuadPart = length;
+    bool truncated = SetFilePointerEx(fileHandle, position, NULL, FILE_BEGIN) && SetEndOfFile(fileHandle);
+    CloseHandle(fileHandle);
+    return truncated;
+#else
+    return truncate(fileName.c_str(), (off_t)length) == 0;
+#endif
+}
+
+bool SnapshotMatchesLog(string logName, const vehicleSnapshot &snap){
+    if (FileSize(logName) < snap.outputOffset){
+        return false; // missing, or shorter than the snapshot says
+    }
+    // logged text mode, so skip any "\r" the platform wrote; twice the tail always covers it
+    int64_t readLength = std::min(snap.outputOffset, (int64_t)(2 * logTailLength));
+    string bytes(readLength, '\0');
+    ifstream log(logName, std::ios_base::binary);
+    if (readLength > 0 &&
+        !(log.seekg(snap.outputOffset - readLength) && log.read(&bytes[0], readLength))){
+        return false;
+    }
+    bytes.erase(std::remove(bytes.begin(), bytes.end(), '\r'), bytes.end());
+    return bytes.size() >= snap.logTail.size() &&
+        bytes.compare(bytes.size() - snap.logTail.size(), string::npos, snap.logTail) == 0;
+}
+
+template <typename T>
+void AppendBytes(string &buffer, const T &value){
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool ReadBytes(istream &in, T &value){
+    return (bool)in.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+string SerializeFleetSnapshot(std::vector<Vehicle*> &fleet){
+    string buffer(snapshotMagic, sizeof(snapshotMagic));
+    AppendBytes(buffer, snapshotVersion);
+    AppendBytes(buffer, (uint32_t)fleet.size());
+    for (auto aVehicle : fleet) {
+        string ident = aVehicle->GetIdent();
+        vehicleSnapshot snap = aVehicle->GetSnapshot();
+        AppendBytes(buffer, (uint32_t)ident.size());
+        buffer.append(ident);
+        AppendBytes(buffer, snap.currentLocation.latitude);
+        AppendBytes(buffer, snap.currentLocation.longitude);
+        AppendBytes(buffer, snap.currentBearing);
+        AppendBytes(buffer, snap.lastElapsedTime);
+        AppendBytes(buffer, snap.rngState);
+        AppendBytes(buffer, snap.outputOffset);
+        AppendBytes(buffer, snap.waypointsDone);
+        AppendBytes(buffer, snap.waypointsTotal);
+        AppendBytes(buffer, (uint32_t)snap.logTail.size());
+        buffer.append(snap.logTail);
+    }
+    return buffer;
+}
+
+bool LoadFleetSnapshot(std::vector<Vehicle*> &fleet, string fileName){
+    /**
+     * Vehicles are matched by position, the fleet must be constructed
+     * in the same order as the run that wrote the snapshot.
+     */
+    ifstream in(fileName, std::ios_base::binary);
+    char magic[sizeof(snapshotMagic)];
+    uint32_t version;
+    uint32_t count;
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), snapshotMagic) ||
+        !ReadBytes(in, version) || version != snapshotVersion ||
+        !ReadBytes(in, count) || count != fleet.size()){
+        return false;
+    }
+    std::vector<vehicleSnapshot> snaps(count);
+    for (uint32_t i = 0; i < count; i++){
+        uint32_t identLength;
+        if (!ReadBytes(in, identLength) || identLength > maxIdentLength){
+            return false;
+        }
+        string ident(identLength, '\0');
+        vehicleSnapshot &snap = snaps[i];
+        if (!in.read(&ident[0], identLength) || ident != fleet[i]->GetIdent() ||
+            !ReadBytes(in, snap.currentLocation.latitude) ||
+            !ReadBytes(in, snap.currentLocation.longitude) ||
+            !ReadBytes(in, snap.currentBearing) ||
+            !ReadBytes(in, snap.lastElapsedTime) ||
+            !ReadBytes(in, snap.rngState) ||
+            !ReadBytes(in, snap.outputOffset) ||
+            !ReadBytes(in, snap.waypointsDone) ||
+            !ReadBytes(in, snap.waypointsTotal)){
+            return false;
+        }
+        uint32_t tailLength;
+        if (!ReadBytes(in, tailLength) || tailLength > logTailLength){
+            return false;
+        }
+        snap.logTail.assign(tailLength, '\0');
+        if ((tailLength > 0 && !in.read(&snap.logTail[0], tailLength)) ||
+            snap.outputOffset < 0 || snap.waypointsDone < 0 ||
+            snap.waypointsTotal < snap.waypointsDone){
+            return false;
+        }
     }
+    // every log must belong to this snapshot before any of them is touched
+    for (uint32_t i = 0; i < count; i++){
+        if (!SnapshotMatchesLog(fleet[i]->GetIdent() + ".JNY", snaps[i])){
+            return false;
+        }
+    }
+    // drop anything logged after the snapshot so the resumed run appends exactly where it left off
+    for (uint32_t i = 0; i < count; i++){
+        if (!TruncateFile(fleet[i]->GetIdent() + ".JNY", snaps[i].outputOffset)){
+            return false;
+        }
+        fleet[i]->RestoreSnapshot(snaps[i]);
+    }
+    return true;
+}
+
+class SnapshotWriter {
+        /**
+         * Serializing is cheap and done by the caller, the file write happens
+         * on a background thread so generation carries on while it's in flight.
+         * Written to a temp file then renamed, an interrupted write leaves the
+         * previous snapshot intact.
+         */
+        std::thread worker;
+        string fileName;
+
+    public:
+        SnapshotWriter(string fileName) : fileName(fileName) {}
+
+        ~SnapshotWriter(){
+            Wait();
+        }
+
+        void Write(string buffer){
+            Wait(); // at most one write in flight, normally long finished by now
+            string target = fileName;
+            worker = std::thread([target, buffer](){
+                string tempName = target + ".tmp";
+                ofstream out(tempName, std::ios_base::binary | std::ios_base::trunc);
+                out << buffer;
+                out.close();
+                if (!out){
+                    return;
+                }
+#ifdef _WIN32
+                // rename() will not replace an existing file on Windows
+                MoveFileExA(tempName.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+                rename(tempName.c_str(), target.c_str());
+#endif
+            });
+        }
+
+        void Wait(){
+            if (worker.joinable()){
+                worker.join();
+            }
+        }
+};
+
+void GenerateFleetHistory(std::vector<Vehicle*> &fleet, SnapshotWriter &writer){
+    // straight away, so a plain --resume covers a run (or an --extend) interrupted before its first checkpoint
+    writer.Write(SerializeFleetSnapshot(fleet));
+    int sinceCheckpoint = 0;
+    for (auto aVehicle : fleet) {
+        while (!aVehicle->JourneyComplete()){
+            GenerateWaypoint(*aVehicle);
+            if (++sinceCheckpoint >= checkpointInterval){
+                writer.Write(SerializeFleetSnapshot(fleet));
+                sinceCheckpoint = 0;
+            }
+        }
+    }
+    writer.Write(SerializeFleetSnapshot(fleet)); // final state, so journeys can be extended later
+}
+
+// === Kinematic Simulation ===
+/**
+ * Fixed time-step alternative to GenerateWaypoint(): rather than jumping
+ * straight to each random destination, vehicles steer and accelerate towards
+ * it under PID control, limited by how fast their kind can turn/accelerate,
+ * and a waypoint is logged every emitSeconds of simulated time.
+ *
+ * State is held struct-of-arrays so a tick is one tight loop over the fleet,
+ * KinematicTick(), which vectorizes with "g++ -O3 -fno-math-errno" (sqrt is
+ * otherwise a libm call that may set errno). Small steps use a flat-earth approximation,
+ * destinations still come from destinationGen() and so still honour the geofence.
+ */
+const double degToRad = M_PI / 180.0;
+const double feetPerDegreeLat = 364000.0;  // ~69 statute miles
+const double minCosLatitude = 0.01;        // ~89.4 degrees, keeps longitude steps finite near the poles
+
+/**
+ * KinematicTick() helpers. libm's fmod/sin/cos/atan2 have no portable vector
+ * versions and fmin/fmax's NaN rules have no x86 vector instruction, so these
+ * are plain arithmetic, std::min/std::max and copysign, with no branches or
+ * conditional arithmetic, which keeps the loop vectorizable.
+ */
+inline double arithmeticMax(double a, double b){
+    // std::max() against a constant, multiplied afterwards, gets turned back into a branch
+    return 0.5 * (a + b + fabs(a - b));
+}
+
+inline double wrapDegrees(double d){
+    // to [-180, 180], rounding d / 360 via a conversion rather than a branch or libm call
+    return d - 360.0 * (double)(int)(d / 360.0 + copysign(0.5, d));
+}
+
+inline double sinDegrees(double d){
+    double x = wrapDegrees(d) * degToRad;
+    x = copysign(std::min(fabs(x), M_PI - fabs(x)), x); // sin(pi - x) == sin(x), folds onto [-pi/2, pi/2]
+    double x2 = x * x;
+    // Taylor series to x^15, error < 1e-11 on [-pi/2, pi/2]
+    return x * (1.0 + x2 * (-1.0 / 6.0 + x2 * (1.0 / 120.0 + x2 * (-1.0 / 5040.0 + x2 * (1.0 / 362880.0 +
+            x2 * (-1.0 / 39916800.0 + x2 * (1.0 / 6227020800.0 - x2 / 1307674368000.0)))))));
 }
 
-int main(){
+inline double cosDegrees(double d){
+    return sinDegrees(d + 90.0);
+}
+
+inline double atan2Degrees(double y, double x){
+    double ax = fabs(x);
+    double ay = fabs(y);
+    double a = std::min(ax, ay) / std::max(std::max(ax, ay), 1e-300);
+    double a2 = a * a;
+    // Abramowitz & Stegun 4.4.49, error < 2e-8 radians on [0, 1]
+    double r = a * (1.0 + a2 * (-0.3333314528 + a2 * (0.1999355085 + a2 * (-0.1420889944 +
+            a2 * (0.1065626393 + a2 * (-0.0752896400 + a2 * (0.0429096138 +
+            a2 * (-0.0161657367 + a2 * 0.0028662257))))))));
+    r = M_PI / 4.0 - copysign(M_PI / 4.0 - r, ax - ay); // pi/2 - r when |y| > |x|
+    r = M_PI / 2.0 - copysign(M_PI / 2.0 - r, x);       // pi - r when x < 0
+    return copysign(r, y) / degToRad;
+}
+
+inline double headingError(double lat, double lon, double hdg, double tLat, double tLon, double &dist){
+    double cosLat = arithmeticMax(cosDegrees(lat), minCosLatitude);
+    double north = (tLat - lat) * feetPerDegreeLat;
+    double east = wrapDegrees(tLon - lon) * feetPerDegreeLat * cosLat; // the short way across +/-180
+    dist = sqrt(north * north + east * east);
+    return wrapDegrees(atan2Degrees(east, north) - hdg);
+}
+
+inline double wantedSpeed(double targetSpeed, double maxAccel, double dist, double hErr){
+    // slowing for the arrival and while pointed away from the target
+    double brakingSpeed = sqrt(2.0 * maxAccel * dist);
+    return std::min(targetSpeed, brakingSpeed) * std::max(0.25, cosDegrees(hErr));
+}
+
+inline double conditionalIntegral(double integral, double error, double dt, double rawOutput,
+                                    double outputLimit, double integralLimit){
+    /**
+     * Anti-windup: while the output is saturated the integral only moves in
+     * the direction that brings it back inside the limit. The scaled limits
+     * are 0 when saturated and effectively unbounded otherwise.
+     */
+    const double huge = 1e300;
+    double increment = error * dt;
+    increment = std::min(increment, std::max(0.0, (outputLimit - rawOutput) * huge));
+    increment = std::max(increment, std::min(0.0, -(rawOutput + outputLimit) * huge));
+    return std::min(std::max(integral + increment, -integralLimit), integralLimit);
+}
+
+struct kinematicLimits {
+    double maxTurnRateDps;  // degrees per second
+    double maxAccelFps2;    // feet per second squared
+};
+
+kinematicLimits kinematicLimitsGen(Vehicle &someVehicle){
+    string vehicle_type = someVehicle.GetIdent();
+    kinematicLimits limits = {3.0, 8.0}; // PLANE/unspecified: standard rate turn
+    if(vehicle_type == "CAR"){
+        limits = {25.0, 10.0};
+    } else if (vehicle_type == "BOAT") {
+        limits = {3.0, 1.5};
+    }
+    return limits;
+}
+
+struct pidGains {
+    double kp;
+    double ki;
+    double kd;
+    double integralLimit; // backstop, windup is mainly prevented by conditionalIntegral()
+};
+
+void KinematicTick(size_t n, double dt, const pidGains hg, const pidGains sg,
+                    double* __restrict lat, double* __restrict lon,
+                    double* __restrict hdg, double* __restrict spd,
+                    const double* __restrict tLat, const double* __restrict tLon,
+                    const double* __restrict tSpd, const double* __restrict run,
+                    const double* __restrict turnLimit, const double* __restrict accelLimit,
+                    double* __restrict dist, double* __restrict t,
+                    double* __restrict hInt, double* __restrict hPrev,
+                    double* __restrict sInt, double* __restrict sPrev){
+    // FleetKinematics' arrays as __restrict parameters, GCC ignores __restrict on local pointers
+    for (size_t i = 0; i < n; i++){
+        double distance;
+        double hErr = headingError(lat[i], lon[i], hdg[i], tLat[i], tLon[i], distance);
+        dist[i] = distance;
+
+        // Heading PID, output is a turn rate
+        double rawTurn = hg.kp * hErr + hg.ki * hInt[i] + hg.kd * (hErr - hPrev[i]) / dt;
+        double turn = std::min(std::max(rawTurn, -turnLimit[i]), turnLimit[i]);
+        hInt[i] = conditionalIntegral(hInt[i], hErr, dt, rawTurn, turnLimit[i], hg.integralLimit);
+        hPrev[i] = hErr;
+        double newHeading = wrapDegrees(hdg[i] + turn * dt * run[i] - 180.0) + 180.0; // [0, 360]
+        hdg[i] = newHeading;
+
+        // Speed PID, output is an acceleration
+        double sErr = wantedSpeed(tSpd[i], accelLimit[i], distance, hErr) - spd[i];
+        double rawAccel = sg.kp * sErr + sg.ki * sInt[i] + sg.kd * (sErr - sPrev[i]) / dt;
+        double accel = std::min(std::max(rawAccel, -accelLimit[i]), accelLimit[i]);
+        sInt[i] = conditionalIntegral(sInt[i], sErr, dt, rawAccel, accelLimit[i], sg.integralLimit);
+        sPrev[i] = sErr;
+        spd[i] = std::max(0.0, spd[i] + accel * dt * run[i]);
+
+        double step = spd[i] * dt * run[i];
+        double cosLat = arithmeticMax(cosDegrees(lat[i]), minCosLatitude);
+        double newLat = lat[i] + step * cosDegrees(newHeading) / feetPerDegreeLat;
+        lon[i] = wrapDegrees(lon[i] + step * sinDegrees(newHeading) / (feetPerDegreeLat * cosLat));
+        lat[i] = std::min(std::max(newLat, -90.0), 90.0);
+        t[i] += dt * run[i];
+    }
+}
+
+class FleetKinematics {
+        std::vector<Vehicle*> vehicles;
+
+        // Struct-of-arrays vehicle state, index i is vehicles[i]
+        std::vector<double> latitude;
+        std::vector<double> longitude;
+        std::vector<double> heading;          // degrees, [0, 360] like Vehicle::SetBearing()
+        std::vector<double> speed;            // feet per second
+        std::vector<double> targetLatitude;
+        std::vector<double> targetLongitude;
+        std::vector<double> targetSpeed;
+        std::vector<double> distanceToTarget; // feet
+        std::vector<double> elapsed;          // seconds, continues from the vehicle's last waypoint
+        std::vector<double> active;           // 1.0 while the journey runs, multiplies motion so the tick has no branches
+
+        // Controller state
+        std::vector<double> headingIntegral;
+        std::vector<double> headingPrevError;
+        std::vector<double> speedIntegral;
+        std::vector<double> speedPrevError;
+        std::vector<double> maxTurnRate;
+        std::vector<double> maxAccel;
+
+        pidGains headingGains = {1.0, 0.02, 0.2, 100.0};
+        pidGains speedGains = {0.5, 0.01, 0.0, 200.0};
+        double tickSeconds;
+        int emitTicks;
+        double arrivalFeet = 200.0;
+
+        void Retarget(size_t i){
+            // hand the current state back to the Vehicle so destinationGen() works from it
+            Vehicle &aVehicle = *vehicles[i];
+            location here = {latitude[i], longitude[i]};
+            aVehicle.SetLocation(here);
+            aVehicle.SetBearing(heading[i]);
+            location destination = destinationGen(aVehicle);
+            targetLatitude[i] = destination.latitude;
+            targetLongitude[i] = destination.longitude;
+            targetSpeed[i] = groundSpeedGen(aVehicle);
+            // previous errors against the new target so the jump in target gives no derivative kick,
+            // and no integral carried over from the old one
+            double dist;
+            double hErr = headingError(latitude[i], longitude[i], heading[i],
+                                        targetLatitude[i], targetLongitude[i], dist);
+            headingPrevError[i] = hErr;
+            speedPrevError[i] = wantedSpeed(targetSpeed[i], maxAccel[i], dist, hErr) - speed[i];
+            headingIntegral[i] = 0.0;
+            speedIntegral[i] = 0.0;
+            distanceToTarget[i] = dist;
+        }
+
+    public:
+        FleetKinematics(double tickSeconds, double emitSeconds)
+            : tickSeconds(tickSeconds), emitTicks(std::max(1, (int)(emitSeconds / tickSeconds))) {}
+
+        void Add(Vehicle &aVehicle){
+            kinematicLimits limits = kinematicLimitsGen(aVehicle);
+            location here = aVehicle.GetLocation();
+            vehicles.push_back(&aVehicle);
+            latitude.push_back(here.latitude);
+            longitude.push_back(here.longitude);
+            heading.push_back(aVehicle.GetBearing());
+            speed.push_back(0.0);
+            targetLatitude.push_back(here.latitude);
+            targetLongitude.push_back(here.longitude);
+            targetSpeed.push_back(0.0);
+            distanceToTarget.push_back(0.0);
+            elapsed.push_back(aVehicle.GetPreviousWaypointTime());
+            active.push_back(aVehicle.JourneyComplete() ? 0.0 : 1.0);
+            headingIntegral.push_back(0.0);
+            headingPrevError.push_back(0.0);
+            speedIntegral.push_back(0.0);
+            speedPrevError.push_back(0.0);
+            maxTurnRate.push_back(limits.maxTurnRateDps);
+            maxAccel.push_back(limits.maxAccelFps2);
+            if (active.back() > 0.0){
+                Retarget(vehicles.size() - 1);
+            }
+        }
+
+        void Tick(){
+            KinematicTick(vehicles.size(), tickSeconds, headingGains, speedGains,
+                        latitude.data(), longitude.data(), heading.data(), speed.data(),
+                        targetLatitude.data(), targetLongitude.data(), targetSpeed.data(),
+                        active.data(), maxTurnRate.data(), maxAccel.data(),
+                        distanceToTarget.data(), elapsed.data(),
+                        headingIntegral.data(), headingPrevError.data(),
+                        speedIntegral.data(), speedPrevError.data());
+        }
+
+        void Run(){
+            /**
+             * Arrivals and waypoint logging touch the Vehicle objects and files,
+             * so they are kept out of Tick() and only scanned for afterwards.
+             */
+            bool running = true;
+            for (long tick = 1; running; tick++){
+                Tick();
+                running = false;
+                for (size_t i = 0; i < vehicles.size(); i++){
+                    if (active[i] == 0.0){
+                        continue;
+                    }
+                    if (distanceToTarget[i] < arrivalFeet + speed[i] * tickSeconds){
+                        Retarget(i);
+                    }
+                    if (tick % emitTicks == 0){
+                        Vehicle &aVehicle = *vehicles[i];
+                        location thisPoint = {latitude[i], longitude[i]};
+                        aVehicle.SetLocation(thisPoint);
+                        aVehicle.SetBearing(heading[i]);
+                        aVehicle.AddToWaypointHistory(thisPoint, elapsed[i]);
+                        aVehicle.RecordWaypointDone();
+                        if (aVehicle.JourneyComplete()){
+                            active[i] = 0.0;
+                        }
+                    }
+                    running = running || active[i] > 0.0;
+                }
+            }
+        }
+};
+
+int main(int argc, char* argv[]){
+    /**
+     * usage: main [--resume] [--extend N] [--snapshot FILE] [--kinematic] [--mask FILE]
+     *        main --build-mask FILE
+     *   --resume    continue from the last snapshot instead of starting new journeys
+     *   --extend N  add N more waypoints to every journey (typically with --resume)
+     *   --kinematic steer each vehicle with FleetKinematics, waypoints every kinematicEmitSeconds
+     *   --mask FILE use a boat zone mask from --build-mask for geofence checks
+     */
+    string snapshotFile = "FLEET.SNAP";
+    bool resume = false;
+    bool kinematic = false;
+    int extraWaypoints = 0;
+    for (int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if (arg == "--resume"){
+            resume = true;
+        } else if (arg == "--kinematic"){
+            kinematic = true;
+        } else if (arg == "--build-mask" && i + 1 < argc){
+            if (!BuildBoatZoneMask(argv[i + 1])){
+                cout << "could not write " << argv[i + 1] << "\n";
+                return 1;
+            }
+            return 0;
+        } else if (arg == "--mask" && i + 1 < argc){
+            string maskFile = argv[++i];
+            if (!boatZoneMask.Open(maskFile)){
+                // only an accelerator, carry on with the exact checks
+                cout << "ignoring unusable mask " << maskFile << "\n";
+            }
+        } else if (arg == "--extend" && i + 1 < argc){
+            extraWaypoints = atoi(argv[++i]);
+        } else if (arg == "--snapshot" && i + 1 < argc){
+            snapshotFile = argv[++i];
+        } else {
+            cout << "unknown argument: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (kinematic && resume){
+        // controller state and targets are not part of the snapshot
+        cout << "--kinematic runs cannot be resumed\n";
+        return 1;
+    }
+
     Vehicle plane("PLANE","747",735000,195.66,63.413,231.82);
     Vehicle isidore("CAR","SVC00919",3860,5.18,6.4,13.2,"Fiat",1981,"SPORTS","REGULAR");
     Vehicle peters_barque("BOAT","Oceanis 60",48600,16.75,120.5,59.83,"SAIL",8.2,"Beneteau");
+    std::vector<Vehicle*> fleet = {&plane, &isidore, &peters_barque};
+
+    if (resume){
+        if (!LoadFleetSnapshot(fleet, snapshotFile)){
+            cout << "could not resume from " << snapshotFile << "\n";
+            return 1;
+        }
+    } else {
+        // the logs are about to be rewritten, an older snapshot no longer describes them
+        remove(snapshotFile.c_str());
+        for (auto aVehicle : fleet) { // seeded at construction, a resume restores the seeds instead
+            aVehicle->StartLog();
+        }
 
-    location thisPoint = {40.154742, -105.173916};
-    isidore.SetLocation(thisPoint);
-    isidore.AddToWaypointHistory(thisPoint, 0.0);
+        location thisPoint = {40.154742, -105.173916};
+        isidore.SetLocation(thisPoint);
+        isidore.AddToWaypointHistory(thisPoint, 0.0);
+        PlanWaypointHistory(isidore);
 
-    location thatPoint = {45.048124, -31.565813};
-    peters_barque.SetLocation(thatPoint);
-    peters_barque.AddToWaypointHistory(thatPoint,0.0);
+        location thatPoint = {45.048124, -31.565813};
+        peters_barque.SetLocation(thatPoint);
+        peters_barque.AddToWaypointHistory(thatPoint,0.0);
+        PlanWaypointHistory(peters_barque);
+    }
 
-    GenerateWaypointHistory(isidore);
-    GenerateWaypointHistory(peters_barque);
-}
\ No newline at end of file
+    if (extraWaypoints > 0){
+        for (auto aVehicle : fleet) {
+            if (aVehicle->GetWaypointsTotal() > 0){ // the plane has no journey to extend
+                aVehicle->SetWaypointsTotal(aVehicle->GetWaypointsTotal() + extraWaypoints);
+            }
+        }
+    }
+
+    if (kinematic){
+        const double kinematicTickSeconds = 1.0;
+        const double kinematicEmitSeconds = 120.0;
+        FleetKinematics simulation(kinematicTickSeconds, kinematicEmitSeconds);
+        for (auto aVehicle : fleet) {
+            simulation.Add(*aVehicle);
+        }
+        simulation.Run();
+        return 0;
+    }
+
+    SnapshotWriter writer(snapshotFile);
+    GenerateFleetHistory(fleet, writer);
+}